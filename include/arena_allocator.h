@@ -1,7 +1,8 @@
+#pragma once
+
 #include <cstddef>
 #include <memory>
 
-#pragma
 namespace Allocator {
 template <typename T> class ArenaAllocator {
   public:
@@ -45,6 +46,12 @@ template <typename T> class ArenaAllocator {
         space_ = size_;
     }
 
+    // Rewind the arena but keep its memory for the next round of allocations.
+    constexpr void reset() {
+        offset_ = 0;
+        space_ = size_;
+    }
+
   private:
     using RawData = std::aligned_storage_t<sizeof(T), alignof(T)>;
     std::unique_ptr<RawData[]> ptr_ = nullptr;
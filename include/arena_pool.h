@@ -0,0 +1,150 @@
+#pragma once
+
+#include "arena_allocator.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Allocator {
+namespace detail {
+// Small dense index per thread, used to pick a home slot in an ArenaPool.
+inline std::size_t this_thread_index() {
+    static std::atomic<std::size_t> next_index{0};
+    thread_local const std::size_t index =
+        next_index.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+} // namespace detail
+
+// Pool of equally sized arenas for per request scratch memory. Every thread
+// has a home slot that caches a few released arenas, so acquire and release
+// are a single atomic exchange in the common case. When the home slot is
+// empty arenas are stolen from other slots before a new one is created.
+// Released arenas are rewound but keep their memory.
+template <typename T> class ArenaPool {
+  public:
+    using Arena = ArenaAllocator<T>;
+
+    class Lease {
+      public:
+        constexpr Lease() = default;
+        constexpr Lease(ArenaPool *pool, Arena *arena)
+            : pool_(pool), arena_(arena) {}
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+        constexpr Lease(Lease &&other)
+            : pool_(std::exchange(other.pool_, nullptr)),
+              arena_(std::exchange(other.arena_, nullptr)) {}
+        Lease &operator=(Lease &&other) {
+            if (this != &other) {
+                release();
+                pool_ = std::exchange(other.pool_, nullptr);
+                arena_ = std::exchange(other.arena_, nullptr);
+            }
+            return *this;
+        }
+        ~Lease() { release(); }
+
+        constexpr Arena *get() const { return arena_; }
+        constexpr Arena *operator->() const { return arena_; }
+        constexpr Arena &operator*() const { return *arena_; }
+        constexpr explicit operator bool() const { return arena_ != nullptr; }
+
+      private:
+        void release() {
+            if (pool_ && arena_) {
+                pool_->release(arena_);
+            }
+            pool_ = nullptr;
+            arena_ = nullptr;
+        }
+
+        ArenaPool *pool_ = nullptr;
+        Arena *arena_ = nullptr;
+    };
+
+    explicit ArenaPool(std::size_t arena_size, std::size_t num_slots = 64)
+        : arena_size_(arena_size),
+          num_slots_(std::max<std::size_t>(num_slots, 1)),
+          slots_(std::make_unique<Slot[]>(num_slots_)) {}
+
+    ArenaPool(const ArenaPool &) = delete;
+    ArenaPool &operator=(const ArenaPool &) = delete;
+
+    // All leases must be released before the pool is destroyed.
+    ~ArenaPool() = default;
+
+    [[nodiscard]] Lease acquire() {
+        const std::size_t home = detail::this_thread_index() % num_slots_;
+        for (std::size_t i = 0; i < num_slots_; ++i) {
+            if (auto *arena = take_from(slots_[(home + i) % num_slots_])) {
+                return Lease{this, arena};
+            }
+        }
+
+        std::lock_guard lock{mutex_};
+        if (!overflow_.empty()) {
+            auto *arena = overflow_.back();
+            overflow_.pop_back();
+            return Lease{this, arena};
+        }
+        auto &arena =
+            arenas_.emplace_back(std::make_unique<Arena>(arena_size_));
+        return Lease{this, arena.get()};
+    }
+
+    // Number of arenas created so far, leased or idle.
+    std::size_t count_arenas() const {
+        std::lock_guard lock{mutex_};
+        return arenas_.size();
+    }
+
+  private:
+    static constexpr std::size_t arenas_per_slot = 4;
+
+    struct alignas(64) Slot {
+        std::array<std::atomic<Arena *>, arenas_per_slot> arenas_{};
+    };
+
+    static Arena *take_from(Slot &slot) {
+        for (auto &cached : slot.arenas_) {
+            if (cached.load(std::memory_order_relaxed) == nullptr) {
+                continue;
+            }
+            if (auto *arena =
+                    cached.exchange(nullptr, std::memory_order_acquire)) {
+                return arena;
+            }
+        }
+        return nullptr;
+    }
+
+    void release(Arena *arena) {
+        arena->reset();
+        auto &slot = slots_[detail::this_thread_index() % num_slots_];
+        for (auto &cached : slot.arenas_) {
+            Arena *expected = nullptr;
+            if (cached.compare_exchange_strong(expected, arena,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        std::lock_guard lock{mutex_};
+        overflow_.push_back(arena);
+    }
+
+    std::size_t arena_size_{};
+    std::size_t num_slots_{};
+    std::unique_ptr<Slot[]> slots_;
+    mutable std::mutex mutex_{};
+    std::vector<std::unique_ptr<Arena>> arenas_{};
+    std::vector<Arena *> overflow_{};
+};
+} // namespace Allocator
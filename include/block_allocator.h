@@ -1,29 +1,42 @@
 #pragma once
 
+#include "block_storage.h"
+#include "exhaustion_policy.h"
+#include "sampling_profiler.h"
+
 #include <algorithm>
 #include <cassert>
+#include <condition_variable>
 #include <cstddef>
-#include <iostream>
-#include <list>
-#include <memory>
+#include <mutex>
+#include <type_traits>
 
 namespace Allocator {
+namespace detail {
+struct NoWaitState {};
+struct WaitState {
+    std::mutex mutex_{};
+    std::condition_variable freed_{};
+};
+} // namespace detail
 
-template <typename T> class BlockAllocator {
+// Fixed size block allocator. ExhaustionPolicyT decides what happens when no
+// block is free, StorageT how blocks and their occupancy are stored.
+template <typename T, typename ExhaustionPolicyT = ExhaustionPolicy::FailFast,
+          template <typename> typename StorageT = BlockStorage::List>
+class BlockAllocator {
   private:
-    struct Block {
-        constexpr Block() = default;
-        alignas(T) std::array<std::byte, sizeof(T)> data_{};
-        bool is_free_{true};
-    };
+    static constexpr bool is_waiting =
+        std::is_same_v<ExhaustionPolicyT, ExhaustionPolicy::Block>;
 
   public:
-    constexpr explicit BlockAllocator(std::size_t num_blocks)
-        : num_blocks_(num_blocks) {
-        for (int i = 0; i < num_blocks_; ++i) {
-            list_.emplace_back(std::make_unique_for_overwrite<Block>());
-        }
-    }
+    using exhaustion_policy_type = ExhaustionPolicyT;
+    // Whether allocate/deallocate may be called from several threads.
+    static constexpr bool is_synchronized = is_waiting;
+
+    constexpr explicit BlockAllocator(std::size_t num_blocks,
+                                      ExhaustionPolicyT policy = {})
+        : num_blocks_(num_blocks), policy_(policy), storage_(num_blocks) {}
 
     constexpr std::size_t get_max_storage() const {
         return num_blocks_ * sizeof(T);
@@ -33,58 +46,97 @@ template <typename T> class BlockAllocator {
         if (n != sizeof(T)) {
             return nullptr;
         }
-        auto *block = find_free_block();
-        if (!block) {
-            std::cout << "Failed to find free block\n";
-            return nullptr;
+        if constexpr (is_waiting) {
+            std::unique_lock lock{wait_state_.mutex_};
+            T *ptr = nullptr;
+            auto found = [this, &ptr] {
+                ptr = storage_.take_free();
+                return ptr != nullptr;
+            };
+            if (policy_.timeout == std::chrono::nanoseconds::max()) {
+                wait_state_.freed_.wait(lock, found);
+            } else if (!wait_state_.freed_.wait_for(lock, policy_.timeout,
+                                                    found)) {
+                return nullptr;
+            }
+            if (profiler_) [[unlikely]] {
+                profiler_->record_allocation(ptr, n);
+            }
+            return ptr;
+        } else {
+            T *ptr = take_free_or_grow();
+            if (profiler_) [[unlikely]] {
+                profiler_->record_allocation(ptr, n);
+            }
+            return ptr;
         }
-        block->is_free_ = false;
-        return reinterpret_cast<T *>(block->data_.data());
     }
 
     constexpr void deallocate(T *ptr) {
         if (!ptr) {
             return;
         }
-        auto block_it =
-            std::find_if(list_.begin(), list_.end(), [ptr](auto &block) {
-                if (block) {
-                    auto *block_ptr =
-                        reinterpret_cast<T *>(block->data_.data());
-                    if (!block_ptr) {
-                        return false;
-                    }
-                    return block_ptr == ptr;
-                }
-                return false;
-            });
-        if (block_it != list_.end()) {
-            (*block_it)->is_free_ = true;
+        if constexpr (is_waiting) {
+            {
+                std::lock_guard lock{wait_state_.mutex_};
+                release(ptr);
+            }
+            wait_state_.freed_.notify_one();
+        } else {
+            release(ptr);
         }
     }
 
     constexpr std::size_t count_occupied_blocks() const {
-        std::size_t count{};
-        for (const auto &block : list_) {
-            if (block && !block->is_free_) {
-                ++count;
-            }
+        if constexpr (is_waiting) {
+            std::lock_guard lock{wait_state_.mutex_};
+            return storage_.count_occupied();
+        } else {
+            return storage_.count_occupied();
         }
-        return count;
+    }
+
+    // Attach a profiler, or detach with nullptr. Must not race with
+    // allocate/deallocate.
+    constexpr void set_profiler(SamplingProfiler *profiler) {
+        profiler_ = profiler;
     }
 
   private:
-    Block *find_free_block() const {
-        auto it = std::find_if(list_.cbegin(), list_.cend(), [](auto &block) {
-            return block && block->is_free_;
-        });
-        if (it == list_.end()) {
-            return nullptr;
+    constexpr void release(T *ptr) {
+        if (profiler_) [[unlikely]] {
+            profiler_->record_deallocation(ptr);
+        }
+        storage_.release(ptr);
+    }
+
+    constexpr T *take_free_or_grow() {
+        T *ptr = storage_.take_free();
+        if constexpr (std::is_same_v<ExhaustionPolicyT,
+                                     ExhaustionPolicy::Grow>) {
+            if (ptr) {
+                return ptr;
+            }
+            const std::size_t max_blocks = policy_.max_bytes / sizeof(T);
+            if (num_blocks_ >= max_blocks) {
+                return nullptr;
+            }
+            const std::size_t grow_by =
+                std::min(std::max<std::size_t>(num_blocks_, 1),
+                         max_blocks - num_blocks_);
+            storage_.add_blocks(grow_by);
+            num_blocks_ += grow_by;
+            return storage_.take_free();
         }
-        return (*it).get();
+        return ptr;
     }
 
     std::size_t num_blocks_{};
-    std::list<std::unique_ptr<Block>> list_{};
+    [[no_unique_address]] ExhaustionPolicyT policy_{};
+    SamplingProfiler *profiler_ = nullptr;
+    mutable std::conditional_t<is_waiting, detail::WaitState,
+                               detail::NoWaitState>
+        wait_state_{};
+    StorageT<T> storage_;
 };
-} // namespace Allocator
\ No newline at end of file
+} // namespace Allocator
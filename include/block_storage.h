@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define ALLOCATOR_HAS_AVX2_DISPATCH 1
+#endif
+
+namespace Allocator {
+namespace detail {
+inline std::size_t find_non_full_word_scalar(const std::uint64_t *words,
+                                             std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        if (words[i] != ~std::uint64_t{0}) {
+            return i;
+        }
+    }
+    return n;
+}
+
+#ifdef ALLOCATOR_HAS_AVX2_DISPATCH
+__attribute__((target("avx2"))) inline std::size_t
+find_non_full_word_avx2(const std::uint64_t *words, std::size_t n) {
+    const __m256i full = _mm256_set1_epi64x(-1);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i));
+        const auto mask = static_cast<unsigned>(_mm256_movemask_pd(
+            _mm256_castsi256_pd(_mm256_cmpeq_epi64(v, full))));
+        if (mask != 0xF) {
+            return i + std::countr_zero(~mask);
+        }
+    }
+    return i + find_non_full_word_scalar(words + i, n - i);
+}
+#endif
+
+// Index of the first word with a clear bit, or n if every word is full. Uses
+// AVX2 when the CPU supports it.
+inline std::size_t find_non_full_word(const std::uint64_t *words,
+                                      std::size_t n) {
+    using FindFn = std::size_t (*)(const std::uint64_t *, std::size_t);
+    static const FindFn find = []() -> FindFn {
+#ifdef ALLOCATOR_HAS_AVX2_DISPATCH
+        if (__builtin_cpu_supports("avx2")) {
+            return find_non_full_word_avx2;
+        }
+#endif
+        return find_non_full_word_scalar;
+    }();
+    return find(words, n);
+}
+} // namespace detail
+
+namespace BlockStorage {
+
+// Every block is a separate heap node with its own free flag.
+template <typename T> class List {
+  private:
+    struct Block {
+        constexpr Block() = default;
+        alignas(T) std::array<std::byte, sizeof(T)> data_{};
+        bool is_free_{true};
+    };
+
+  public:
+    constexpr explicit List(std::size_t num_blocks) { add_blocks(num_blocks); }
+
+    constexpr void add_blocks(std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            list_.emplace_back(std::make_unique_for_overwrite<Block>());
+        }
+    }
+
+    constexpr T *take_free() {
+        auto it = std::find_if(list_.begin(), list_.end(), [](auto &block) {
+            return block && block->is_free_;
+        });
+        if (it == list_.end()) {
+            return nullptr;
+        }
+        (*it)->is_free_ = false;
+        return reinterpret_cast<T *>((*it)->data_.data());
+    }
+
+    constexpr void release(T *ptr) {
+        auto block_it =
+            std::find_if(list_.begin(), list_.end(), [ptr](auto &block) {
+                if (block) {
+                    auto *block_ptr =
+                        reinterpret_cast<T *>(block->data_.data());
+                    if (!block_ptr) {
+                        return false;
+                    }
+                    return block_ptr == ptr;
+                }
+                return false;
+            });
+        if (block_it != list_.end()) {
+            (*block_it)->is_free_ = true;
+        }
+    }
+
+    constexpr std::size_t count_occupied() const {
+        std::size_t count{};
+        for (const auto &block : list_) {
+            if (block && !block->is_free_) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+  private:
+    std::list<std::unique_ptr<Block>> list_{};
+};
+
+// Blocks are stored densely in chunks, occupancy is kept in a bitmap with one
+// bit per block. Free blocks are found word by word from the lowest word that
+// may have a clear bit.
+template <typename T> class Bitmap {
+  private:
+    static constexpr std::size_t bits_per_word = 64;
+
+    struct Slot {
+        alignas(T) std::array<std::byte, sizeof(T)> data_;
+    };
+
+    struct Chunk {
+        std::unique_ptr<Slot[]> slots_;
+        std::size_t size_{};
+        std::size_t first_index_{};
+    };
+
+  public:
+    constexpr explicit Bitmap(std::size_t num_blocks) {
+        add_blocks(num_blocks);
+    }
+
+    constexpr void add_blocks(std::size_t count) {
+        if (count == 0) {
+            return;
+        }
+        chunks_.push_back(
+            Chunk{std::make_unique_for_overwrite<Slot[]>(count), count,
+                  num_blocks_});
+        const std::size_t total = num_blocks_ + count;
+        // Bits past the last block stay set so they are never handed out.
+        words_.resize((total + bits_per_word - 1) / bits_per_word,
+                      ~std::uint64_t{0});
+        for (std::size_t i = num_blocks_; i < total; ++i) {
+            words_[i / bits_per_word] &=
+                ~(std::uint64_t{1} << (i % bits_per_word));
+        }
+        search_start_ = std::min(search_start_, num_blocks_ / bits_per_word);
+        num_blocks_ = total;
+    }
+
+    constexpr T *take_free() {
+        const std::size_t word =
+            search_start_ +
+            detail::find_non_full_word(words_.data() + search_start_,
+                                       words_.size() - search_start_);
+        search_start_ = word;
+        if (word == words_.size()) {
+            return nullptr;
+        }
+        const auto bit = std::countr_zero(~words_[word]);
+        words_[word] |= std::uint64_t{1} << bit;
+        return slot_at(word * bits_per_word + bit);
+    }
+
+    constexpr void release(T *ptr) {
+        const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+        for (const auto &chunk : chunks_) {
+            const auto begin =
+                reinterpret_cast<std::uintptr_t>(chunk.slots_.get());
+            if (address < begin ||
+                address >= begin + chunk.size_ * sizeof(Slot)) {
+                continue;
+            }
+            const std::size_t index =
+                chunk.first_index_ + (address - begin) / sizeof(Slot);
+            const std::size_t word = index / bits_per_word;
+            words_[word] &= ~(std::uint64_t{1} << (index % bits_per_word));
+            search_start_ = std::min(search_start_, word);
+            return;
+        }
+    }
+
+    constexpr std::size_t count_occupied() const {
+        std::size_t count{};
+        for (const auto word : words_) {
+            count += std::popcount(word);
+        }
+        return count - (words_.size() * bits_per_word - num_blocks_);
+    }
+
+  private:
+    constexpr T *slot_at(std::size_t index) const {
+        for (const auto &chunk : chunks_) {
+            if (index < chunk.first_index_ + chunk.size_) {
+                return reinterpret_cast<T *>(
+                    chunk.slots_[index - chunk.first_index_].data_.data());
+            }
+        }
+        return nullptr;
+    }
+
+    std::vector<Chunk> chunks_{};
+    std::vector<std::uint64_t> words_{};
+    std::size_t num_blocks_{};
+    // Every word before this one is full.
+    std::size_t search_start_{};
+};
+
+} // namespace BlockStorage
+} // namespace Allocator
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "sampling_profiler.h"
+
 #include <cassert>
 #include <cstddef>
 #include <memory>
@@ -112,9 +114,13 @@ template <typename T, typename PlacementPolicyT> class BoundaryTagAllocator {
         if (new_pool) {
             available_memory = new_pool;
         }
-        return reinterpret_cast<T *>(
+        auto *ptr = reinterpret_cast<T *>(
             reinterpret_cast<std::uintptr_t>(new_block) +
             sizeof(detail::Block));
+        if (profiler_) [[unlikely]] {
+            profiler_->record_allocation(ptr, n);
+        }
+        return ptr;
     }
 
     template <typename... ArgsT>
@@ -126,6 +132,9 @@ template <typename T, typename PlacementPolicyT> class BoundaryTagAllocator {
         if (!ptr) {
             return;
         }
+        if (profiler_) [[unlikely]] {
+            profiler_->record_deallocation(ptr);
+        }
         detail::Block *block = reinterpret_cast<detail::Block *>(ptr) - 1;
         if (!block) {
             return;
@@ -147,10 +156,16 @@ template <typename T, typename PlacementPolicyT> class BoundaryTagAllocator {
         p->~T();
     }
 
+    // Attach a profiler, or detach with nullptr.
+    constexpr void set_profiler(SamplingProfiler *profiler) {
+        profiler_ = profiler;
+    }
+
   private:
     std::size_t total_size_{};
     detail::Block *available_memory = nullptr;
     using RawData = std::byte;
     std::unique_ptr<RawData[]> ptr_ = nullptr;
+    SamplingProfiler *profiler_ = nullptr;
 };
 } // namespace Allocator
\ No newline at end of file
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "boundary_tag_allocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace Allocator {
+namespace detail {
+// Header in front of every block. Blocks are laid out back to back so the
+// next block always starts size_ bytes after this one.
+struct RelocatableBlock {
+    std::size_t size_{};
+    std::uint32_t handle_{};
+    bool is_free_{true};
+};
+} // namespace detail
+
+// Stable reference to memory in a CompactingBoundaryTagAllocator. Resolve it
+// with get() every time the memory is used, a compact() call may move it.
+struct RelocatableHandle {
+    static constexpr std::uint32_t invalid_index =
+        std::numeric_limits<std::uint32_t>::max();
+
+    std::uint32_t index_{invalid_index};
+    std::uint32_t generation_{};
+
+    constexpr explicit operator bool() const {
+        return index_ != invalid_index;
+    }
+};
+
+// Boundary tag allocator that hands out handles instead of raw pointers, so
+// live blocks can be slid together by compact() to remove fragmentation.
+// Free blocks are found first fit. Memory is moved with memmove, hence T must
+// be trivially copyable.
+template <typename T> class CompactingBoundaryTagAllocator {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Relocated memory is moved with memmove");
+    using Header = detail::RelocatableBlock;
+
+  public:
+    constexpr CompactingBoundaryTagAllocator() = default;
+    constexpr explicit CompactingBoundaryTagAllocator(std::size_t size)
+        : total_size_(size),
+          ptr_(std::make_unique_for_overwrite<RawData[]>(size)) {
+        auto *head = new (ptr_.get()) Header{};
+        head->size_ = total_size_;
+    }
+
+    constexpr std::size_t max_size() const { return total_size_; }
+    constexpr std::size_t count_occupied_memory() const { return occupied_; }
+
+    std::size_t largest_free_block() const {
+        std::size_t largest{};
+        std::size_t run{};
+        for (std::size_t offset = 0; offset < total_size_;) {
+            const auto *block = header_at(offset);
+            run = block->is_free_ ? run + block->size_ : 0;
+            largest = std::max(largest, run);
+            offset += block->size_;
+        }
+        return largest;
+    }
+
+    RelocatableHandle allocate(std::size_t n) {
+        assert(n >= sizeof(T));
+        if (!ptr_) {
+            return {};
+        }
+        const std::size_t aligned_size =
+            align_size<T, Header>(n + sizeof(Header));
+
+        for (std::size_t offset = 0; offset < total_size_;) {
+            auto *block = header_at(offset);
+            if (block->is_free_) {
+                merge_free_run(offset);
+                if (block->size_ >= aligned_size) {
+                    split(offset, aligned_size);
+                    return claim(offset);
+                }
+            }
+            offset += block->size_;
+        }
+        return {};
+    }
+
+    void deallocate(RelocatableHandle handle) {
+        if (!is_valid(handle)) {
+            return;
+        }
+        auto &entry = handles_[handle.index_];
+        auto *block = header_at(entry.offset_);
+        block->is_free_ = true;
+        occupied_ -= block->size_;
+        merge_free_run(entry.offset_);
+        compact_cursor_ = std::min(compact_cursor_, entry.offset_);
+
+        ++entry.generation_;
+        free_handles_.push_back(handle.index_);
+    }
+
+    T *get(RelocatableHandle handle) const {
+        if (!is_valid(handle)) {
+            return nullptr;
+        }
+        return reinterpret_cast<T *>(ptr_.get() +
+                                     handles_[handle.index_].offset_ +
+                                     sizeof(Header));
+    }
+
+    // Slide live blocks towards the start of the heap. Work per call is
+    // bounded by budget: every moved block costs its size and every live block
+    // stepped over costs sizeof its header. One exception keeps compaction
+    // making progress: the first block of a call is moved or stepped over even
+    // when it alone exceeds budget. Returns the number of bytes moved, which
+    // may be 0 while compaction is still unfinished, check is_compacted().
+    std::size_t compact(std::size_t budget) {
+        std::size_t moved{};
+        std::size_t spent{};
+        while (compact_cursor_ < total_size_) {
+            auto *gap = header_at(compact_cursor_);
+            if (!gap->is_free_) {
+                if (spent > 0 && spent + sizeof(Header) > budget) {
+                    break;
+                }
+                spent += sizeof(Header);
+                compact_cursor_ += gap->size_;
+                continue;
+            }
+            merge_free_run(compact_cursor_);
+            const std::size_t gap_size = gap->size_;
+            const std::size_t live_offset = compact_cursor_ + gap_size;
+            if (live_offset >= total_size_) {
+                break;
+            }
+            auto *live = header_at(live_offset);
+            const std::size_t live_size = live->size_;
+            if (spent > 0 && spent + live_size > budget) {
+                break;
+            }
+
+            std::memmove(gap, live, live_size);
+            handles_[gap->handle_].offset_ = compact_cursor_;
+            compact_cursor_ += live_size;
+
+            auto *new_gap = new (header_at(compact_cursor_)) Header{};
+            new_gap->size_ = gap_size;
+            moved += live_size;
+            spent += live_size;
+        }
+        return moved;
+    }
+
+    constexpr bool is_compacted() const {
+        return compact_cursor_ >= total_size_ ||
+               (header_at(compact_cursor_)->is_free_ &&
+                compact_cursor_ + header_at(compact_cursor_)->size_ >=
+                    total_size_);
+    }
+
+  private:
+    struct HandleEntry {
+        std::size_t offset_{};
+        std::uint32_t generation_{};
+    };
+
+    constexpr Header *header_at(std::size_t offset) const {
+        return reinterpret_cast<Header *>(ptr_.get() + offset);
+    }
+
+    constexpr bool is_valid(RelocatableHandle handle) const {
+        return handle && handle.index_ < handles_.size() &&
+               handles_[handle.index_].generation_ == handle.generation_;
+    }
+
+    // Merge every free block directly following the free block at offset.
+    constexpr void merge_free_run(std::size_t offset) {
+        auto *block = header_at(offset);
+        while (offset + block->size_ < total_size_) {
+            auto *next = header_at(offset + block->size_);
+            if (!next->is_free_) {
+                break;
+            }
+            block->size_ += next->size_;
+        }
+    }
+
+    constexpr void split(std::size_t offset, std::size_t size) {
+        auto *block = header_at(offset);
+        if (block->size_ <= size + sizeof(Header)) {
+            return;
+        }
+        auto *rest = new (header_at(offset + size)) Header{};
+        rest->size_ = block->size_ - size;
+        block->size_ = size;
+    }
+
+    RelocatableHandle claim(std::size_t offset) {
+        std::uint32_t index{};
+        if (free_handles_.empty()) {
+            index = static_cast<std::uint32_t>(handles_.size());
+            handles_.emplace_back();
+        } else {
+            index = free_handles_.back();
+            free_handles_.pop_back();
+        }
+        auto &entry = handles_[index];
+        entry.offset_ = offset;
+
+        auto *block = header_at(offset);
+        block->is_free_ = false;
+        block->handle_ = index;
+        occupied_ += block->size_;
+        return RelocatableHandle{index, entry.generation_};
+    }
+
+    std::size_t total_size_{};
+    std::size_t occupied_{};
+    // Every block in front of the cursor is live.
+    std::size_t compact_cursor_{};
+    using RawData = std::byte;
+    std::unique_ptr<RawData[]> ptr_ = nullptr;
+    std::vector<HandleEntry> handles_{};
+    std::vector<std::uint32_t> free_handles_{};
+};
+} // namespace Allocator
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "block_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Allocator {
+
+// Epoch based reclamation on top of a BlockAllocator. Readers pin the current
+// epoch while they hold pointers into the pool, writers retire pointers they
+// have unlinked. A retired pointer is destroyed and handed back to the
+// BlockAllocator once the global epoch has moved two steps past the epoch it
+// was retired in, i.e. when no pinned reader can still observe it.
+template <typename T, typename AllocT = BlockAllocator<T>>
+class EpochReclaimer {
+    using Retired = std::pair<std::uint64_t, T *>;
+
+  public:
+    // Per thread state. Only the owning thread may pin or retire through it.
+    class Participant {
+      public:
+        class Guard {
+          public:
+            Guard(const Guard &) = delete;
+            Guard &operator=(const Guard &) = delete;
+            constexpr Guard(Guard &&other)
+                : owner_(std::exchange(other.owner_, nullptr)) {}
+            Guard &operator=(Guard &&) = delete;
+            ~Guard() {
+                if (owner_) {
+                    owner_->unpin();
+                }
+            }
+
+          private:
+            friend class Participant;
+            constexpr explicit Guard(Participant *owner) : owner_(owner) {}
+
+            Participant *owner_ = nullptr;
+        };
+
+        explicit Participant(EpochReclaimer &reclaimer)
+            : reclaimer_(reclaimer) {}
+
+        [[nodiscard]] Guard pin() {
+            // Nested pins keep the outermost epoch.
+            if (pin_depth_++ > 0) {
+                return Guard{this};
+            }
+            std::uint64_t epoch =
+                reclaimer_.global_epoch_.load(std::memory_order_relaxed);
+            while (true) {
+                state_.store((epoch << 1) | 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                const auto current =
+                    reclaimer_.global_epoch_.load(std::memory_order_relaxed);
+                if (current == epoch) {
+                    break;
+                }
+                epoch = current;
+            }
+            return Guard{this};
+        }
+
+        // Queue ptr for reclamation. ptr must have been returned by create()
+        // and already be unreachable for readers that pin after this call.
+        void retire(T *ptr) {
+            if (!ptr) {
+                return;
+            }
+            retired_.emplace_back(
+                reclaimer_.global_epoch_.load(std::memory_order_seq_cst), ptr);
+            if (retired_.size() >= reclaimer_.batch_size_) {
+                flush();
+            }
+        }
+
+        // Try to advance the epoch and return every safe pointer to the pool,
+        // including those left behind by unregistered participants.
+        void flush() {
+            reclaimer_.try_advance();
+            const auto epoch =
+                reclaimer_.global_epoch_.load(std::memory_order_acquire);
+            {
+                std::lock_guard lock{reclaimer_.alloc_mutex_};
+                reclaimer_.reclaim_safe(retired_, epoch);
+            }
+            if (reclaimer_.orphan_count_.load(std::memory_order_relaxed)) {
+                std::scoped_lock lock{reclaimer_.participants_mutex_,
+                                      reclaimer_.alloc_mutex_};
+                reclaimer_.reclaim_safe(reclaimer_.orphans_, epoch);
+                reclaimer_.orphan_count_.store(reclaimer_.orphans_.size(),
+                                               std::memory_order_relaxed);
+            }
+        }
+
+        constexpr std::size_t count_retired() const { return retired_.size(); }
+
+      private:
+        friend class EpochReclaimer;
+
+        void unpin() {
+            if (--pin_depth_ == 0) {
+                state_.store(0, std::memory_order_release);
+            }
+        }
+
+        EpochReclaimer &reclaimer_;
+        // (epoch << 1) | 1 while pinned, 0 otherwise.
+        std::atomic<std::uint64_t> state_{0};
+        std::size_t pin_depth_{};
+        std::vector<Retired> retired_{};
+    };
+
+    constexpr explicit EpochReclaimer(AllocT &alloc,
+                                      std::size_t batch_size = 64)
+        : alloc_(alloc), batch_size_(std::max<std::size_t>(batch_size, 1)) {}
+
+    EpochReclaimer(const EpochReclaimer &) = delete;
+    EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+
+    // Every thread must be quiescent when the reclaimer is destroyed.
+    ~EpochReclaimer() { reclaim_all(); }
+
+    // Returned reference stays valid until unregister_participant() or the
+    // end of the reclaimer's lifetime.
+    Participant &register_participant() {
+        std::lock_guard lock{participants_mutex_};
+        return *participants_.emplace_back(
+            std::make_unique<Participant>(*this));
+    }
+
+    // Remove an unpinned participant, e.g. when its thread exits. Pointers it
+    // still has retired are reclaimed by the next flush of any participant.
+    void unregister_participant(Participant &participant) {
+        std::lock_guard lock{participants_mutex_};
+        orphans_.insert(orphans_.end(), participant.retired_.begin(),
+                        participant.retired_.end());
+        orphan_count_.store(orphans_.size(), std::memory_order_relaxed);
+        participants_.remove_if(
+            [&participant](const auto &p) { return p.get() == &participant; });
+    }
+
+    // Allocate a block from the pool and construct a T in it. Unless the
+    // allocator is synchronized, all pool access from threads using this
+    // reclaimer should go through here. Returns nullptr when the pool is
+    // exhausted, with the Block policy this waits for a flush to free a block.
+    template <typename... ArgsT> T *create(ArgsT &&...args) {
+        T *ptr = allocate_block();
+        if (!ptr) {
+            return nullptr;
+        }
+        try {
+            std::construct_at(ptr, std::forward<ArgsT>(args)...);
+        } catch (...) {
+            deallocate_block(ptr);
+            throw;
+        }
+        return ptr;
+    }
+
+    constexpr std::uint64_t epoch() const {
+        return global_epoch_.load(std::memory_order_acquire);
+    }
+
+    // Advance the global epoch if every pinned participant has observed it.
+    bool try_advance() {
+        std::lock_guard lock{participants_mutex_};
+        auto epoch = global_epoch_.load(std::memory_order_seq_cst);
+        for (const auto &participant : participants_) {
+            const auto state =
+                participant->state_.load(std::memory_order_seq_cst);
+            if ((state & 1) && (state >> 1) != epoch) {
+                return false;
+            }
+        }
+        return global_epoch_.compare_exchange_strong(epoch, epoch + 1,
+                                                     std::memory_order_acq_rel);
+    }
+
+    // Return every retired pointer regardless of epoch. Only safe when no
+    // participant is pinned.
+    void reclaim_all() {
+        std::scoped_lock lock{participants_mutex_, alloc_mutex_};
+        constexpr auto any_epoch = std::numeric_limits<std::uint64_t>::max();
+        for (auto &participant : participants_) {
+            reclaim_safe(participant->retired_, any_epoch);
+        }
+        reclaim_safe(orphans_, any_epoch);
+        orphan_count_.store(0, std::memory_order_relaxed);
+    }
+
+  private:
+    // A synchronized allocator locks itself and may wait for a block that a
+    // flush on another thread frees, so alloc_mutex_ must not be held then.
+    T *allocate_block() {
+        if constexpr (AllocT::is_synchronized) {
+            return alloc_.allocate(sizeof(T));
+        } else {
+            std::lock_guard lock{alloc_mutex_};
+            return alloc_.allocate(sizeof(T));
+        }
+    }
+
+    void deallocate_block(T *ptr) {
+        if constexpr (AllocT::is_synchronized) {
+            alloc_.deallocate(ptr);
+        } else {
+            std::lock_guard lock{alloc_mutex_};
+            alloc_.deallocate(ptr);
+        }
+    }
+
+    // Destroy and deallocate every entry retired at least two epochs before
+    // epoch. alloc_mutex_ must be held.
+    void reclaim_safe(std::vector<Retired> &retired, std::uint64_t epoch) {
+        auto safe = std::stable_partition(
+            retired.begin(), retired.end(), [epoch](const auto &entry) {
+                return epoch < 2 || entry.first > epoch - 2;
+            });
+        for (auto it = safe; it != retired.end(); ++it) {
+            std::destroy_at(it->second);
+            alloc_.deallocate(it->second);
+        }
+        retired.erase(safe, retired.end());
+    }
+
+    AllocT &alloc_;
+    std::size_t batch_size_{};
+    std::atomic<std::uint64_t> global_epoch_{0};
+    std::mutex participants_mutex_{};
+    std::mutex alloc_mutex_{};
+    std::list<std::unique_ptr<Participant>> participants_{};
+    // Retired pointers of unregistered participants, guarded by
+    // participants_mutex_.
+    std::vector<Retired> orphans_{};
+    std::atomic<std::size_t> orphan_count_{0};
+};
+} // namespace Allocator
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace Allocator::ExhaustionPolicy {
+
+// Return nullptr as soon as no free block is left.
+struct FailFast {};
+
+// Add blocks on demand until the pool holds max_bytes worth of blocks. The
+// pool roughly doubles each time it grows.
+struct Grow {
+    std::size_t max_bytes{};
+};
+
+// Wait for another thread to deallocate a block. Gives up and returns nullptr
+// after timeout. Allocate and deallocate are serialized by a mutex.
+struct Block {
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max();
+};
+
+} // namespace Allocator::ExhaustionPolicy
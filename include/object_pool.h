@@ -0,0 +1,164 @@
+#pragma once
+
+#include "block_allocator.h"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Allocator {
+
+enum class RecyclePolicy {
+    // Released objects are destroyed and their block returned to the pool.
+    Destroy,
+    // Released objects are reset and kept constructed for the next acquire.
+    Warm,
+};
+
+// Calls obj.reset() if T has one, otherwise leaves the object as is.
+struct DefaultReset {
+    template <typename T> constexpr void operator()(T &obj) const {
+        if constexpr (requires { obj.reset(); }) {
+            obj.reset();
+        }
+    }
+};
+
+// Typed pool on top of a BlockAllocator handing out RAII handles. AllocT
+// selects the exhaustion policy and block storage of the underlying pool.
+template <typename T, typename ResetT = DefaultReset,
+          typename AllocT = BlockAllocator<T>>
+class ObjectPool {
+  public:
+    class Deleter {
+      public:
+        constexpr Deleter() = default;
+        constexpr explicit Deleter(ObjectPool *pool) : pool_(pool) {}
+        constexpr void operator()(T *p) const {
+            if (pool_) {
+                pool_->release(p);
+            }
+        }
+
+      private:
+        ObjectPool *pool_ = nullptr;
+    };
+    using Handle = std::unique_ptr<T, Deleter>;
+
+    constexpr explicit ObjectPool(
+        std::size_t num_objects, RecyclePolicy policy = RecyclePolicy::Destroy,
+        ResetT reset = {},
+        typename AllocT::exhaustion_policy_type exhaustion = {})
+        : alloc_(num_objects, exhaustion), policy_(policy),
+          reset_(std::move(reset)) {
+        if (policy_ == RecyclePolicy::Warm) {
+            // Room for every object the pool can ever hold, so releasing
+            // never allocates.
+            std::size_t capacity = num_objects;
+            if constexpr (std::is_same_v<
+                              typename AllocT::exhaustion_policy_type,
+                              ExhaustionPolicy::Grow>) {
+                capacity =
+                    std::max(capacity, exhaustion.max_bytes / sizeof(T));
+            }
+            warm_.reserve(capacity);
+        }
+    }
+
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    // All handles must be released before the pool is destroyed.
+    ~ObjectPool() { trim(); }
+
+    // Construct a new object from args. Returns an empty handle when the pool
+    // is exhausted. With the Warm policy an idle warm object is destroyed to
+    // make room if no block is free. The pool itself is not thread safe, so
+    // with the Block exhaustion policy nothing can free a block while acquire
+    // waits and an exhausted pool returns an empty handle after the timeout.
+    template <typename... ArgsT> [[nodiscard]] Handle acquire(ArgsT &&...args) {
+        T *p = nullptr;
+        if constexpr (AllocT::is_synchronized) {
+            // A waiting allocate would never return while idle warm objects
+            // hold the blocks, so recycle one of them first.
+            p = take_warm_block();
+        }
+        if (!p) {
+            p = alloc_.allocate(sizeof(T));
+        }
+        if (!p) {
+            p = take_warm_block();
+        }
+        if (!p) {
+            return Handle{nullptr, Deleter{this}};
+        }
+        try {
+            std::construct_at(p, std::forward<ArgsT>(args)...);
+        } catch (...) {
+            alloc_.deallocate(p);
+            throw;
+        }
+        return Handle{p, Deleter{this}};
+    }
+
+    // Reuse a reset warm object, or default construct a new one when none is
+    // idle. Returns an empty handle when the pool is exhausted.
+    [[nodiscard]] Handle acquire_warm()
+        requires std::default_initializable<T>
+    {
+        if (!warm_.empty()) {
+            T *p = warm_.back();
+            warm_.pop_back();
+            return Handle{p, Deleter{this}};
+        }
+        return acquire();
+    }
+
+    // Destroy every warm object and return its block to the allocator.
+    void trim() {
+        for (T *p : warm_) {
+            std::destroy_at(p);
+            alloc_.deallocate(p);
+        }
+        warm_.clear();
+    }
+
+    constexpr std::size_t count_warm() const { return warm_.size(); }
+    constexpr std::size_t count_warm_capacity() const {
+        return warm_.capacity();
+    }
+    constexpr std::size_t count_occupied_blocks() const {
+        return alloc_.count_occupied_blocks();
+    }
+
+  private:
+    T *take_warm_block() {
+        if (warm_.empty()) {
+            return nullptr;
+        }
+        T *p = warm_.back();
+        warm_.pop_back();
+        std::destroy_at(p);
+        return p;
+    }
+
+    void release(T *p) {
+        if (policy_ == RecyclePolicy::Warm) {
+            reset_(*p);
+            warm_.push_back(p);
+            return;
+        }
+        std::destroy_at(p);
+        alloc_.deallocate(p);
+    }
+
+    AllocT alloc_;
+    RecyclePolicy policy_{RecyclePolicy::Destroy};
+    [[no_unique_address]] ResetT reset_{};
+    std::vector<T *> warm_{};
+};
+} // namespace Allocator
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <unwind.h>
+
+namespace Allocator {
+
+// Sampling heap profiler that allocators report to when one is attached.
+// Roughly every sample_interval bytes an allocation is sampled together with
+// a stack trace and kept until it is freed. The distance between samples is
+// drawn from an exponential distribution so periodic allocation patterns do
+// not bias the profile. A sample_interval of 0 samples every allocation.
+//
+// One profiler may be shared by several allocators and threads. Unsampled
+// allocations only update an atomic byte counter and frees of unsampled
+// pointers are filtered by an atomic per address bucket count. Only sampling
+// and freeing a sampled pointer (or one sharing its bucket) take a mutex.
+class SamplingProfiler {
+  public:
+    // Innermost frames first. The first frame is the allocator's allocate()
+    // that record_allocation() is inlined into, or its caller when
+    // allocate() itself was inlined.
+    static constexpr std::size_t max_frames = 16;
+    using Stack = std::array<const void *, max_frames>;
+
+    struct Sample {
+        std::size_t size_{};
+        Stack frames_{};
+        std::size_t depth_{};
+    };
+
+    explicit SamplingProfiler(std::size_t sample_interval,
+                              std::uint64_t seed = std::random_device{}())
+        : sample_interval_(sample_interval), rng_(seed),
+          distance_(sample_interval ? 1.0 / sample_interval : 1.0) {
+        bytes_until_sample_ = next_distance();
+    }
+
+    // Always inlined so the frame recording the sample is the allocator's.
+    [[gnu::always_inline]] void record_allocation(const void *ptr,
+                                                  std::size_t size) {
+        if (!ptr) {
+            return;
+        }
+        if (sample_interval_ != 0) {
+            const auto remaining = static_cast<std::ptrdiff_t>(size);
+            const auto before = bytes_until_sample_.fetch_sub(
+                remaining, std::memory_order_relaxed);
+            // Only the allocation crossing zero samples, others skip until
+            // the countdown is reset.
+            if (before > remaining || before <= 0) {
+                return;
+            }
+        }
+        record_sample(ptr, size);
+    }
+
+    void record_deallocation(const void *ptr) {
+        auto &bucket = buckets_[bucket_of(ptr)];
+        if (bucket.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+        std::lock_guard lock{mutex_};
+        if (live_.erase(ptr)) {
+            bucket.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    constexpr std::size_t sample_interval() const { return sample_interval_; }
+    std::size_t count_live_samples() const {
+        std::lock_guard lock{mutex_};
+        return live_.size();
+    }
+
+    // Unbiased estimate of the bytes a sample of this size stands for.
+    double estimated_bytes(std::size_t size) const {
+        if (sample_interval_ == 0 || size == 0) {
+            return static_cast<double>(size);
+        }
+        const double s = static_cast<double>(size);
+        return s / (1.0 - std::exp(-s / sample_interval_));
+    }
+
+    // Flat text report of live sampled memory grouped by stack, largest
+    // first. Addresses can be symbolized with addr2line.
+    void report(std::ostream &os) const {
+        struct Site {
+            Stack frames_{};
+            std::size_t depth_{};
+            std::size_t samples_{};
+            std::size_t sampled_bytes_{};
+            double estimated_bytes_{};
+        };
+        std::vector<Site> sites{};
+        std::lock_guard lock{mutex_};
+        for (const auto &[ptr, sample] : live_) {
+            auto it = std::find_if(
+                sites.begin(), sites.end(), [&sample](const Site &site) {
+                    return site.depth_ == sample.depth_ &&
+                           site.frames_ == sample.frames_;
+                });
+            if (it == sites.end()) {
+                it = sites.insert(sites.end(),
+                                  Site{sample.frames_, sample.depth_});
+            }
+            ++it->samples_;
+            it->sampled_bytes_ += sample.size_;
+            it->estimated_bytes_ += estimated_bytes(sample.size_);
+        }
+        std::sort(sites.begin(), sites.end(),
+                  [](const Site &lhs, const Site &rhs) {
+                      return lhs.estimated_bytes_ > rhs.estimated_bytes_;
+                  });
+
+        double total{};
+        for (const auto &site : sites) {
+            total += site.estimated_bytes_;
+        }
+        os << "heap profile: " << live_.size() << " samples, "
+           << static_cast<std::size_t>(total)
+           << " estimated bytes, interval " << sample_interval_ << '\n';
+        for (const auto &site : sites) {
+            os << static_cast<std::size_t>(site.estimated_bytes_) << ' '
+               << site.sampled_bytes_ << ' ' << site.samples_ << " @";
+            for (std::size_t i = 0; i < site.depth_; ++i) {
+                os << ' ' << site.frames_[i];
+            }
+            os << '\n';
+        }
+    }
+
+  private:
+    struct UnwindState {
+        Stack *frames_ = nullptr;
+        std::size_t depth_{};
+        std::size_t skip_{};
+    };
+
+    static _Unwind_Reason_Code unwind_frame(_Unwind_Context *context,
+                                            void *arg) {
+        auto &state = *static_cast<UnwindState *>(arg);
+        if (state.skip_ > 0) {
+            --state.skip_;
+            return _URC_NO_REASON;
+        }
+        const auto ip = _Unwind_GetIP(context);
+        if (ip == 0 || state.depth_ == max_frames) {
+            return _URC_END_OF_STACK;
+        }
+        (*state.frames_)[state.depth_++] = reinterpret_cast<const void *>(ip);
+        return _URC_NO_REASON;
+    }
+
+    // Not inlined so the frames skipped below are always this function and
+    // record_sample(), and the trace starts in the allocator.
+    [[gnu::noinline]] static std::size_t capture_stack(Stack &frames) {
+        UnwindState state{&frames, 0, 2};
+        _Unwind_Backtrace(unwind_frame, &state);
+        return state.depth_;
+    }
+
+    [[gnu::noinline]] void record_sample(const void *ptr, std::size_t size) {
+        Sample sample{size};
+        sample.depth_ = capture_stack(sample.frames_);
+
+        std::lock_guard lock{mutex_};
+        if (live_.insert_or_assign(ptr, sample).second) {
+            buckets_[bucket_of(ptr)].fetch_add(1, std::memory_order_release);
+        }
+        bytes_until_sample_.store(next_distance(), std::memory_order_relaxed);
+    }
+
+    static std::size_t bucket_of(const void *ptr) {
+        // Fibonacci hashing, allocations are at least 8 byte aligned.
+        const std::uint64_t address =
+            reinterpret_cast<std::uintptr_t>(ptr) >> 3;
+        return (address * 0x9E3779B97F4A7C15ull) >> (64 - bucket_bits);
+    }
+
+    std::ptrdiff_t next_distance() {
+        if (sample_interval_ == 0) {
+            return 0;
+        }
+        return static_cast<std::ptrdiff_t>(distance_(rng_)) + 1;
+    }
+
+    std::size_t sample_interval_{};
+    std::atomic<std::ptrdiff_t> bytes_until_sample_{};
+    static constexpr std::size_t bucket_bits = 10;
+    // Number of live samples per address bucket.
+    std::array<std::atomic<std::uint32_t>, 1 << bucket_bits> buckets_{};
+    mutable std::mutex mutex_{};
+    std::mt19937_64 rng_;
+    std::exponential_distribution<double> distance_;
+    std::unordered_map<const void *, Sample> live_{};
+};
+} // namespace Allocator
@@ -0,0 +1,82 @@
+#include "arena_pool.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(ArenaPool, Acquire) {
+    Allocator::ArenaPool<int> pool{1024};
+    auto arena = pool.acquire();
+    ASSERT_TRUE(arena);
+    EXPECT_EQ(arena->max_size(), 1024);
+    EXPECT_TRUE(arena->allocate(sizeof(int)));
+    EXPECT_EQ(pool.count_arenas(), 1);
+}
+
+TEST(ArenaPool, ReuseOnSameThread) {
+    Allocator::ArenaPool<int> pool{1024};
+    Allocator::ArenaAllocator<int> *first = nullptr;
+    {
+        auto arena = pool.acquire();
+        first = arena.get();
+        for (std::size_t i = 0; i < arena->max_size() / sizeof(int); ++i) {
+            EXPECT_TRUE(arena->allocate(sizeof(int)));
+        }
+    }
+    auto arena = pool.acquire();
+    EXPECT_EQ(arena.get(), first);
+    // Released arenas are rewound
+    EXPECT_TRUE(arena->allocate(sizeof(int)));
+    EXPECT_EQ(pool.count_arenas(), 1);
+}
+
+TEST(ArenaPool, Nested) {
+    Allocator::ArenaPool<int> pool{1024};
+    {
+        auto outer = pool.acquire();
+        auto inner = pool.acquire();
+        EXPECT_NE(outer.get(), inner.get());
+    }
+    EXPECT_EQ(pool.count_arenas(), 2);
+    auto a = pool.acquire();
+    auto b = pool.acquire();
+    EXPECT_EQ(pool.count_arenas(), 2);
+}
+
+TEST(ArenaPool, StealFromIdleThread) {
+    Allocator::ArenaPool<int> pool{1024};
+    std::thread{[&pool] { auto arena = pool.acquire(); }}.join();
+    EXPECT_EQ(pool.count_arenas(), 1);
+
+    auto arena = pool.acquire();
+    EXPECT_TRUE(arena);
+    EXPECT_EQ(pool.count_arenas(), 1);
+}
+
+TEST(ArenaPool, Concurrent) {
+    constexpr int num_threads = 4;
+    constexpr int iterations = 1000;
+    Allocator::ArenaPool<int> pool{256};
+    std::atomic<int> completed{0};
+    std::vector<std::thread> threads{};
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&pool, &completed] {
+            for (int i = 0; i < iterations; ++i) {
+                auto arena = pool.acquire();
+                auto *p = arena->allocate(sizeof(int));
+                ASSERT_TRUE(p);
+                *p = i;
+            }
+            ++completed;
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(completed.load(), num_threads);
+    // Each thread holds one lease at a time. An arena being released while
+    // another thread scans the slots can be missed, so allow some slack, but
+    // arenas must be reused rather than created per acquire.
+    EXPECT_LE(pool.count_arenas(), 2 * num_threads);
+}
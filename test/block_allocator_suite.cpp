@@ -1,6 +1,8 @@
 #include "block_allocator.h"
 
 #include <gtest/gtest.h>
+#include <thread>
+#include <vector>
 
 TEST(BlockAllocator, Constructor) {
     constexpr int size = sizeof(int) * 10;
@@ -36,3 +38,116 @@ TEST(BlockAllocator, FillAlloc) {
     }
     EXPECT_EQ(alloc.count_occupied_blocks(), size);
 }
+
+TEST(BlockAllocator, FailFastExhausted) {
+    Allocator::BlockAllocator<int> alloc{1};
+    EXPECT_TRUE(alloc.allocate(sizeof(int)));
+    EXPECT_FALSE(alloc.allocate(sizeof(int)));
+}
+
+TEST(BlockAllocator, GrowUpToCap) {
+    using Policy = Allocator::ExhaustionPolicy::Grow;
+    Allocator::BlockAllocator<int, Policy> alloc{2, Policy{sizeof(int) * 5}};
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(alloc.allocate(sizeof(int)));
+    }
+    EXPECT_EQ(alloc.get_max_storage(), sizeof(int) * 5);
+    EXPECT_EQ(alloc.count_occupied_blocks(), 5);
+    EXPECT_FALSE(alloc.allocate(sizeof(int)));
+}
+
+TEST(BlockAllocator, BlockTimeout) {
+    using Policy = Allocator::ExhaustionPolicy::Block;
+    Allocator::BlockAllocator<int, Policy> alloc{
+        1, Policy{std::chrono::milliseconds{1}}};
+    EXPECT_TRUE(alloc.allocate(sizeof(int)));
+    EXPECT_FALSE(alloc.allocate(sizeof(int)));
+}
+
+TEST(BlockAllocator, BlockUntilFreed) {
+    using Policy = Allocator::ExhaustionPolicy::Block;
+    Allocator::BlockAllocator<int, Policy> alloc{1};
+    auto *first = alloc.allocate(sizeof(int));
+    ASSERT_TRUE(first);
+
+    std::thread consumer{[&alloc, first] {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        alloc.deallocate(first);
+    }};
+    auto *second = alloc.allocate(sizeof(int));
+    consumer.join();
+    EXPECT_EQ(second, first);
+    EXPECT_EQ(alloc.count_occupied_blocks(), 1);
+}
+
+template <typename T>
+using BitmapBlockAllocator =
+    Allocator::BlockAllocator<T, Allocator::ExhaustionPolicy::FailFast,
+                              Allocator::BlockStorage::Bitmap>;
+
+TEST(BitmapBlockAllocator, AllocFree) {
+    BitmapBlockAllocator<int> alloc{10};
+    const auto my_int = alloc.allocate(sizeof(int));
+    EXPECT_TRUE(my_int);
+    EXPECT_EQ(alloc.count_occupied_blocks(), 1);
+
+    alloc.deallocate(my_int);
+    EXPECT_EQ(alloc.count_occupied_blocks(), 0);
+    EXPECT_EQ(alloc.allocate(sizeof(int)), my_int);
+}
+
+TEST(BitmapBlockAllocator, FillAcrossWords) {
+    constexpr int size = 130;
+    BitmapBlockAllocator<int> alloc{size};
+    std::vector<int *> ptrs{};
+    for (int i = 0; i < size; ++i) {
+        auto *p = alloc.allocate(sizeof(int));
+        ASSERT_TRUE(p);
+        *p = i;
+        ptrs.push_back(p);
+    }
+    EXPECT_EQ(alloc.count_occupied_blocks(), size);
+    EXPECT_FALSE(alloc.allocate(sizeof(int)));
+
+    alloc.deallocate(ptrs[70]);
+    EXPECT_EQ(alloc.count_occupied_blocks(), size - 1);
+    EXPECT_EQ(alloc.allocate(sizeof(int)), ptrs[70]);
+    for (int i = 0; i < size; ++i) {
+        if (i != 70) {
+            EXPECT_EQ(*ptrs[i], i);
+        }
+    }
+}
+
+TEST(BitmapBlockAllocator, Grow) {
+    using Policy = Allocator::ExhaustionPolicy::Grow;
+    Allocator::BlockAllocator<int, Policy, Allocator::BlockStorage::Bitmap>
+        alloc{3, Policy{sizeof(int) * 100}};
+    std::vector<int *> ptrs{};
+    while (auto *p = alloc.allocate(sizeof(int))) {
+        ptrs.push_back(p);
+    }
+    EXPECT_EQ(ptrs.size(), 100);
+    EXPECT_EQ(alloc.count_occupied_blocks(), 100);
+    for (auto *p : ptrs) {
+        alloc.deallocate(p);
+    }
+    EXPECT_EQ(alloc.count_occupied_blocks(), 0);
+}
+
+TEST(FindNonFullWord, MatchesScalar) {
+    constexpr std::uint64_t full = ~std::uint64_t{0};
+    for (std::size_t n = 0; n < 12; ++n) {
+        for (std::size_t hole = 0; hole <= n; ++hole) {
+            std::vector<std::uint64_t> words(n, full);
+            if (hole < n) {
+                words[hole] = full - 1;
+            }
+            EXPECT_EQ(Allocator::detail::find_non_full_word(words.data(), n),
+                      hole);
+            EXPECT_EQ(Allocator::detail::find_non_full_word_scalar(
+                          words.data(), n),
+                      hole);
+        }
+    }
+}
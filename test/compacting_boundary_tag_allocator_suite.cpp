@@ -0,0 +1,132 @@
+#include "compacting_boundary_tag_allocator.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+TEST(CompactingBoundaryTagAllocator, Constructor) {
+    constexpr std::size_t size = 1024;
+    Allocator::CompactingBoundaryTagAllocator<int> alloc{size};
+    EXPECT_EQ(alloc.max_size(), size);
+    EXPECT_EQ(alloc.count_occupied_memory(), 0);
+    EXPECT_EQ(alloc.largest_free_block(), size);
+}
+
+TEST(CompactingBoundaryTagAllocator, AllocFree) {
+    constexpr std::size_t size = 1024;
+    Allocator::CompactingBoundaryTagAllocator<int> alloc{size};
+    auto handle = alloc.allocate(sizeof(int));
+    ASSERT_TRUE(handle);
+    *alloc.get(handle) = 5;
+    EXPECT_EQ(*alloc.get(handle), 5);
+    EXPECT_GT(alloc.count_occupied_memory(), 0);
+
+    alloc.deallocate(handle);
+    EXPECT_EQ(alloc.count_occupied_memory(), 0);
+    EXPECT_FALSE(alloc.get(handle));
+}
+
+TEST(CompactingBoundaryTagAllocator, StaleHandle) {
+    Allocator::CompactingBoundaryTagAllocator<int> alloc{1024};
+    auto first = alloc.allocate(sizeof(int));
+    alloc.deallocate(first);
+    auto second = alloc.allocate(sizeof(int));
+    EXPECT_EQ(first.index_, second.index_);
+    EXPECT_FALSE(alloc.get(first));
+    EXPECT_TRUE(alloc.get(second));
+}
+
+TEST(CompactingBoundaryTagAllocator, CompactCheckerboard) {
+    constexpr std::size_t count = 16;
+    Allocator::CompactingBoundaryTagAllocator<int> alloc{1024};
+    std::vector<Allocator::RelocatableHandle> handles{};
+    for (std::size_t i = 0; i < count; ++i) {
+        auto handle = alloc.allocate(sizeof(int));
+        ASSERT_TRUE(handle);
+        *alloc.get(handle) = static_cast<int>(i);
+        handles.push_back(handle);
+    }
+    const auto block_size = alloc.count_occupied_memory() / count;
+    for (std::size_t i = 0; i < count; i += 2) {
+        alloc.deallocate(handles[i]);
+    }
+    const auto occupied = alloc.count_occupied_memory();
+    const auto fragmented_largest = alloc.largest_free_block();
+    EXPECT_FALSE(alloc.is_compacted());
+
+    // One block per call
+    std::size_t calls{};
+    while (!alloc.is_compacted()) {
+        EXPECT_LE(alloc.compact(block_size), block_size);
+        ++calls;
+    }
+    EXPECT_EQ(calls, count / 2);
+    EXPECT_TRUE(alloc.is_compacted());
+    EXPECT_EQ(alloc.count_occupied_memory(), occupied);
+    EXPECT_EQ(alloc.largest_free_block(), alloc.max_size() - occupied);
+    EXPECT_GT(alloc.largest_free_block(), fragmented_largest);
+
+    for (std::size_t i = 1; i < count; i += 2) {
+        EXPECT_EQ(*alloc.get(handles[i]), static_cast<int>(i));
+    }
+}
+
+TEST(CompactingBoundaryTagAllocator, LargeAllocAfterCompact) {
+    constexpr std::size_t size = 1024;
+    Allocator::CompactingBoundaryTagAllocator<int> alloc{size};
+    std::vector<Allocator::RelocatableHandle> handles{};
+    while (auto handle = alloc.allocate(sizeof(int))) {
+        handles.push_back(handle);
+    }
+    for (std::size_t i = 0; i < handles.size(); i += 2) {
+        alloc.deallocate(handles[i]);
+    }
+    const std::size_t large = size / 4;
+    EXPECT_FALSE(alloc.allocate(large));
+
+    alloc.compact(size);
+    EXPECT_TRUE(alloc.is_compacted());
+    EXPECT_TRUE(alloc.allocate(large));
+}
+
+TEST(CompactingBoundaryTagAllocator, FreeDuringCompaction) {
+    Allocator::CompactingBoundaryTagAllocator<int> alloc{1024};
+    std::vector<Allocator::RelocatableHandle> handles{};
+    for (int i = 0; i < 8; ++i) {
+        auto handle = alloc.allocate(sizeof(int));
+        *alloc.get(handle) = i;
+        handles.push_back(handle);
+    }
+    alloc.deallocate(handles[1]);
+    const auto block_size = alloc.count_occupied_memory() / 7;
+    alloc.compact(block_size);
+
+    alloc.deallocate(handles[0]);
+    alloc.compact(1024);
+    EXPECT_TRUE(alloc.is_compacted());
+    for (int i = 2; i < 8; ++i) {
+        EXPECT_EQ(*alloc.get(handles[i]), i);
+    }
+}
+
+TEST(CompactingBoundaryTagAllocator, BoundedWalk) {
+    constexpr std::size_t count = 32;
+    Allocator::CompactingBoundaryTagAllocator<int> alloc{4096};
+    std::vector<Allocator::RelocatableHandle> handles{};
+    for (std::size_t i = 0; i < count; ++i) {
+        handles.push_back(alloc.allocate(sizeof(int)));
+    }
+    // Free the last block, compaction has to walk every live block first
+    alloc.deallocate(handles[count - 2]);
+    alloc.compact(4096);
+    EXPECT_TRUE(alloc.is_compacted());
+
+    // Rewind the cursor to the start, a small budget must not walk the heap
+    alloc.deallocate(handles[0]);
+    const auto block_size = alloc.count_occupied_memory() / (count - 2);
+    std::size_t calls{};
+    while (!alloc.is_compacted()) {
+        EXPECT_LE(alloc.compact(block_size), block_size);
+        ++calls;
+    }
+    EXPECT_GT(calls, 1);
+}
@@ -0,0 +1,188 @@
+#include "epoch_reclaimer.h"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(EpochReclaimer, RetireIsDeferred) {
+    Allocator::BlockAllocator<int> alloc{4};
+    Allocator::EpochReclaimer<int> reclaimer{alloc};
+    auto &self = reclaimer.register_participant();
+
+    auto *p = reclaimer.create();
+    ASSERT_TRUE(p);
+    self.retire(p);
+    EXPECT_EQ(self.count_retired(), 1);
+    EXPECT_EQ(alloc.count_occupied_blocks(), 1);
+}
+
+TEST(EpochReclaimer, PinnedReaderBlocksReclaim) {
+    Allocator::BlockAllocator<int> alloc{4};
+    Allocator::EpochReclaimer<int> reclaimer{alloc};
+    auto &writer = reclaimer.register_participant();
+    auto &reader = reclaimer.register_participant();
+
+    auto *p = reclaimer.create();
+    ASSERT_TRUE(p);
+    {
+        auto guard = reader.pin();
+        writer.retire(p);
+        for (int i = 0; i < 4; ++i) {
+            writer.flush();
+        }
+        EXPECT_EQ(alloc.count_occupied_blocks(), 1);
+    }
+    writer.flush();
+    writer.flush();
+    EXPECT_EQ(writer.count_retired(), 0);
+    EXPECT_EQ(alloc.count_occupied_blocks(), 0);
+}
+
+TEST(EpochReclaimer, BatchFlush) {
+    constexpr std::size_t batch = 4;
+    Allocator::BlockAllocator<int> alloc{batch * 4};
+    Allocator::EpochReclaimer<int> reclaimer{alloc, batch};
+    auto &self = reclaimer.register_participant();
+
+    for (std::size_t i = 0; i < batch * 3; ++i) {
+        self.retire(reclaimer.create());
+    }
+    EXPECT_LT(alloc.count_occupied_blocks(), batch * 3);
+}
+
+TEST(EpochReclaimer, ReclaimAll) {
+    Allocator::BlockAllocator<int> alloc{4};
+    {
+        Allocator::EpochReclaimer<int> reclaimer{alloc};
+        auto &self = reclaimer.register_participant();
+        self.retire(reclaimer.create());
+        self.retire(reclaimer.create());
+        EXPECT_EQ(alloc.count_occupied_blocks(), 2);
+    }
+    EXPECT_EQ(alloc.count_occupied_blocks(), 0);
+}
+
+TEST(EpochReclaimer, UnregisterHandsOverRetired) {
+    Allocator::BlockAllocator<int> alloc{4};
+    Allocator::EpochReclaimer<int> reclaimer{alloc};
+    auto &self = reclaimer.register_participant();
+
+    std::thread{[&reclaimer] {
+        auto &worker = reclaimer.register_participant();
+        worker.retire(reclaimer.create(1));
+        worker.retire(reclaimer.create(2));
+        reclaimer.unregister_participant(worker);
+    }}.join();
+    EXPECT_EQ(alloc.count_occupied_blocks(), 2);
+
+    for (int i = 0; i < 3; ++i) {
+        self.flush();
+    }
+    EXPECT_EQ(alloc.count_occupied_blocks(), 0);
+}
+
+namespace {
+struct Node {
+    static int live_count;
+    explicit Node(int value) : value_(value) { ++live_count; }
+    ~Node() { --live_count; }
+    int value_{};
+};
+int Node::live_count = 0;
+} // namespace
+
+TEST(EpochReclaimer, CreateConstructs) {
+    Allocator::BlockAllocator<Node> alloc{4};
+    {
+        Allocator::EpochReclaimer<Node> reclaimer{alloc};
+        auto &self = reclaimer.register_participant();
+        auto *node = reclaimer.create(5);
+        ASSERT_TRUE(node);
+        EXPECT_EQ(node->value_, 5);
+        EXPECT_EQ(Node::live_count, 1);
+        self.retire(node);
+    }
+    EXPECT_EQ(Node::live_count, 0);
+    EXPECT_EQ(alloc.count_occupied_blocks(), 0);
+}
+
+TEST(EpochReclaimer, ConcurrentRecycle) {
+    constexpr int num_threads = 4;
+    constexpr int iterations = 1000;
+    constexpr std::size_t pool_size = 256;
+    Allocator::BlockAllocator<int> alloc{pool_size};
+    Allocator::EpochReclaimer<int> reclaimer{alloc, 8};
+    std::atomic<int *> shared{reclaimer.create(0)};
+    std::atomic<std::size_t> exchanges{0};
+
+    std::vector<std::thread> threads{};
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&reclaimer, &shared, &exchanges] {
+            auto &self = reclaimer.register_participant();
+            for (int i = 0; i < iterations; ++i) {
+                auto *next = reclaimer.create();
+                if (!next) {
+                    self.flush();
+                    continue;
+                }
+                auto guard = self.pin();
+                *next = *shared.load() + 1;
+                self.retire(shared.exchange(next));
+                ++exchanges;
+            }
+            reclaimer.unregister_participant(self);
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    // Without recycling during the run at most pool_size exchanges succeed.
+    EXPECT_GT(exchanges.load(), pool_size * 4);
+    reclaimer.reclaim_all();
+    EXPECT_EQ(alloc.count_occupied_blocks(), 1);
+}
+
+TEST(EpochReclaimer, BitmapStorage) {
+    using Alloc =
+        Allocator::BlockAllocator<int, Allocator::ExhaustionPolicy::FailFast,
+                                  Allocator::BlockStorage::Bitmap>;
+    Alloc alloc{4};
+    Allocator::EpochReclaimer<int, Alloc> reclaimer{alloc};
+    auto &self = reclaimer.register_participant();
+    self.retire(reclaimer.create(1));
+    EXPECT_EQ(alloc.count_occupied_blocks(), 1);
+    for (int i = 0; i < 3; ++i) {
+        self.flush();
+    }
+    EXPECT_EQ(alloc.count_occupied_blocks(), 0);
+}
+
+TEST(EpochReclaimer, BlockPolicyWaitsForFlush) {
+    using Policy = Allocator::ExhaustionPolicy::Block;
+    using Alloc = Allocator::BlockAllocator<int, Policy>;
+    Alloc alloc{1, Policy{std::chrono::seconds{5}}};
+    Allocator::EpochReclaimer<int, Alloc> reclaimer{alloc};
+    auto &self = reclaimer.register_participant();
+
+    auto *first = reclaimer.create(1);
+    ASSERT_TRUE(first);
+    self.retire(first);
+
+    std::atomic<int *> second{nullptr};
+    std::atomic<bool> done{false};
+    std::thread creator{[&] {
+        // Waits inside the allocator until the flush below frees first
+        second = reclaimer.create(2);
+        done = true;
+    }};
+    while (!done) {
+        self.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    creator.join();
+    ASSERT_TRUE(second.load());
+    EXPECT_EQ(*second.load(), 2);
+    EXPECT_EQ(alloc.count_occupied_blocks(), 1);
+}
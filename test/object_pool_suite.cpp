@@ -0,0 +1,180 @@
+#include "object_pool.h"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+struct Buffered {
+    static int constructor_count;
+    static int destructor_count;
+
+    Buffered() {
+        ++constructor_count;
+        buffer_.reserve(64);
+    }
+    explicit Buffered(int value) : Buffered() { buffer_.push_back(value); }
+    ~Buffered() { ++destructor_count; }
+
+    void reset() { buffer_.clear(); }
+
+    std::vector<int> buffer_{};
+};
+
+int Buffered::constructor_count = 0;
+int Buffered::destructor_count = 0;
+
+void reset_counts() {
+    Buffered::constructor_count = 0;
+    Buffered::destructor_count = 0;
+}
+} // namespace
+
+TEST(ObjectPool, AcquireRelease) {
+    reset_counts();
+    Allocator::ObjectPool<Buffered> pool{4};
+    {
+        auto obj = pool.acquire(5);
+        ASSERT_TRUE(obj);
+        EXPECT_EQ(obj->buffer_.front(), 5);
+        EXPECT_EQ(pool.count_occupied_blocks(), 1);
+    }
+    EXPECT_EQ(pool.count_occupied_blocks(), 0);
+    EXPECT_EQ(Buffered::constructor_count, 1);
+    EXPECT_EQ(Buffered::destructor_count, 1);
+}
+
+TEST(ObjectPool, Exhausted) {
+    Allocator::ObjectPool<int> pool{2};
+    auto a = pool.acquire();
+    auto b = pool.acquire();
+    auto c = pool.acquire();
+    EXPECT_TRUE(a);
+    EXPECT_TRUE(b);
+    EXPECT_FALSE(c);
+}
+
+TEST(ObjectPool, WarmReuse) {
+    reset_counts();
+    Allocator::ObjectPool<Buffered> pool{4, Allocator::RecyclePolicy::Warm};
+    const int *buffer = nullptr;
+    {
+        auto obj = pool.acquire(1);
+        ASSERT_TRUE(obj);
+        buffer = obj->buffer_.data();
+    }
+    EXPECT_EQ(pool.count_warm(), 1);
+    EXPECT_EQ(pool.count_occupied_blocks(), 1);
+    EXPECT_EQ(Buffered::destructor_count, 0);
+    {
+        auto obj = pool.acquire_warm();
+        ASSERT_TRUE(obj);
+        EXPECT_TRUE(obj->buffer_.empty());
+        EXPECT_EQ(obj->buffer_.data(), buffer);
+        EXPECT_EQ(obj->buffer_.capacity(), 64);
+    }
+    EXPECT_EQ(Buffered::constructor_count, 1);
+    EXPECT_EQ(Buffered::destructor_count, 0);
+
+    pool.trim();
+    EXPECT_EQ(pool.count_warm(), 0);
+    EXPECT_EQ(pool.count_occupied_blocks(), 0);
+    EXPECT_EQ(Buffered::destructor_count, 1);
+}
+
+TEST(ObjectPool, CustomReset) {
+    auto reset = [](int &value) { value = -1; };
+    Allocator::ObjectPool<int, decltype(reset)> pool{
+        2, Allocator::RecyclePolicy::Warm, reset};
+    pool.acquire(7).reset();
+    auto obj = pool.acquire_warm();
+    ASSERT_TRUE(obj);
+    EXPECT_EQ(*obj, -1);
+}
+
+TEST(ObjectPool, WarmAcquireKeepsArgs) {
+    Allocator::ObjectPool<int> pool{1, Allocator::RecyclePolicy::Warm};
+    pool.acquire(7).reset();
+    EXPECT_EQ(pool.count_warm(), 1);
+
+    auto obj = pool.acquire(9);
+    ASSERT_TRUE(obj);
+    EXPECT_EQ(*obj, 9);
+    EXPECT_EQ(pool.count_warm(), 0);
+}
+
+namespace {
+struct Throwing {
+    explicit Throwing(bool fail) {
+        if (fail) {
+            throw std::runtime_error{"construction failed"};
+        }
+    }
+};
+} // namespace
+
+TEST(ObjectPool, ThrowingConstructor) {
+    Allocator::ObjectPool<Throwing> pool{1};
+    EXPECT_THROW((void)pool.acquire(true), std::runtime_error);
+    EXPECT_EQ(pool.count_occupied_blocks(), 0);
+    EXPECT_TRUE(pool.acquire(false));
+}
+
+TEST(ObjectPool, BitmapStorageGrow) {
+    using Policy = Allocator::ExhaustionPolicy::Grow;
+    using Alloc = Allocator::BlockAllocator<int, Policy,
+                                            Allocator::BlockStorage::Bitmap>;
+    Allocator::ObjectPool<int, Allocator::DefaultReset, Alloc> pool{
+        2, Allocator::RecyclePolicy::Destroy, {}, Policy{sizeof(int) * 4}};
+    std::vector<decltype(pool)::Handle> handles{};
+    for (int i = 0; i < 4; ++i) {
+        handles.push_back(pool.acquire(i));
+        ASSERT_TRUE(handles.back());
+    }
+    EXPECT_FALSE(pool.acquire());
+    EXPECT_EQ(pool.count_occupied_blocks(), 4);
+    handles.clear();
+    EXPECT_EQ(pool.count_occupied_blocks(), 0);
+}
+
+TEST(ObjectPool, WarmGrow) {
+    using Policy = Allocator::ExhaustionPolicy::Grow;
+    using Alloc = Allocator::BlockAllocator<int, Policy>;
+    Allocator::ObjectPool<int, Allocator::DefaultReset, Alloc> pool{
+        1, Allocator::RecyclePolicy::Warm, {}, Policy{sizeof(int) * 6}};
+    std::vector<decltype(pool)::Handle> handles{};
+    for (int i = 0; i < 6; ++i) {
+        handles.push_back(pool.acquire(i));
+        ASSERT_TRUE(handles.back());
+    }
+    handles.clear();
+    // Reserved up front, the warm cache never reallocated
+    EXPECT_EQ(pool.count_warm(), 6);
+    EXPECT_EQ(pool.count_warm_capacity(), 6);
+}
+
+TEST(ObjectPool, WarmBlockPolicy) {
+    using Policy = Allocator::ExhaustionPolicy::Block;
+    using Alloc = Allocator::BlockAllocator<int, Policy>;
+    Allocator::ObjectPool<int, Allocator::DefaultReset, Alloc> pool{
+        1, Allocator::RecyclePolicy::Warm, {}, Policy{std::chrono::seconds{5}}};
+    pool.acquire(1).reset();
+    EXPECT_EQ(pool.count_warm(), 1);
+
+    // Must recycle the warm block instead of waiting for a free one
+    auto obj = pool.acquire(2);
+    ASSERT_TRUE(obj);
+    EXPECT_EQ(*obj, 2);
+}
+
+TEST(ObjectPool, BlockPolicyTimeout) {
+    using Policy = Allocator::ExhaustionPolicy::Block;
+    using Alloc = Allocator::BlockAllocator<int, Policy>;
+    Allocator::ObjectPool<int, Allocator::DefaultReset, Alloc> pool{
+        1, Allocator::RecyclePolicy::Destroy, {},
+        Policy{std::chrono::milliseconds{1}}};
+    auto obj = pool.acquire(1);
+    EXPECT_TRUE(obj);
+    EXPECT_FALSE(pool.acquire(2));
+}
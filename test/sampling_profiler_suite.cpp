@@ -0,0 +1,166 @@
+#include "block_allocator.h"
+#include "boundary_tag_allocator.h"
+#include "placement_policy.h"
+#include "sampling_profiler.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(SamplingProfiler, SampleEverything) {
+    Allocator::SamplingProfiler profiler{0};
+    int a{};
+    int b{};
+    profiler.record_allocation(&a, sizeof(int));
+    profiler.record_allocation(&b, sizeof(int));
+    EXPECT_EQ(profiler.count_live_samples(), 2);
+
+    profiler.record_deallocation(&a);
+    EXPECT_EQ(profiler.count_live_samples(), 1);
+}
+
+TEST(SamplingProfiler, UnsampledFree) {
+    Allocator::SamplingProfiler profiler{0};
+    std::vector<int> storage(4096);
+    profiler.record_allocation(&storage[0], sizeof(int));
+    // Neighbours and addresses sharing a bucket must not drop the sample
+    for (std::size_t i = 1; i < storage.size(); ++i) {
+        profiler.record_deallocation(&storage[i]);
+    }
+    EXPECT_EQ(profiler.count_live_samples(), 1);
+    profiler.record_deallocation(&storage[0]);
+    EXPECT_EQ(profiler.count_live_samples(), 0);
+}
+
+TEST(SamplingProfiler, SparseSampling) {
+    constexpr std::size_t interval = 1024 * 1024;
+    Allocator::SamplingProfiler profiler{interval, 42};
+    std::vector<int> storage(1000);
+    for (auto &value : storage) {
+        profiler.record_allocation(&value, sizeof(int));
+    }
+    EXPECT_LT(profiler.count_live_samples(), storage.size());
+}
+
+TEST(SamplingProfiler, EstimatedBytes) {
+    Allocator::SamplingProfiler profiler{1024};
+    EXPECT_GT(profiler.estimated_bytes(16), 1024.0);
+    EXPECT_NEAR(profiler.estimated_bytes(1024 * 1024), 1024.0 * 1024, 1.0);
+}
+
+TEST(SamplingProfiler, BlockAllocator) {
+    Allocator::SamplingProfiler profiler{0};
+    Allocator::BlockAllocator<int> alloc{4};
+    alloc.set_profiler(&profiler);
+
+    auto *a = alloc.allocate(sizeof(int));
+    auto *b = alloc.allocate(sizeof(int));
+    EXPECT_EQ(profiler.count_live_samples(), 2);
+
+    alloc.deallocate(a);
+    EXPECT_EQ(profiler.count_live_samples(), 1);
+
+    alloc.set_profiler(nullptr);
+    alloc.deallocate(b);
+    EXPECT_EQ(profiler.count_live_samples(), 1);
+}
+
+TEST(SamplingProfiler, BoundaryTagAllocator) {
+    Allocator::SamplingProfiler profiler{0};
+    Allocator::BoundaryTagAllocator<int, Allocator::PlacementPolicy::FirstFit>
+        alloc{1024};
+    alloc.set_profiler(&profiler);
+
+    auto *a = alloc.allocate(sizeof(int));
+    auto *b = alloc.allocate(sizeof(int));
+    EXPECT_EQ(profiler.count_live_samples(), 2);
+
+    alloc.deallocate(a);
+    alloc.deallocate(b);
+    EXPECT_EQ(profiler.count_live_samples(), 0);
+}
+
+TEST(SamplingProfiler, Report) {
+    Allocator::SamplingProfiler profiler{0};
+    Allocator::BlockAllocator<int> alloc{4};
+    alloc.set_profiler(&profiler);
+    EXPECT_TRUE(alloc.allocate(sizeof(int)));
+    EXPECT_TRUE(alloc.allocate(sizeof(int)));
+
+    std::ostringstream os{};
+    profiler.report(os);
+    const auto report = os.str();
+    EXPECT_NE(report.find("heap profile: 2 samples, 8 estimated bytes"),
+              std::string::npos);
+    EXPECT_NE(report.find(" @ "), std::string::npos);
+}
+
+namespace {
+using ProfiledAllocator = Allocator::BlockAllocator<int>;
+
+[[gnu::noinline]] int *allocate_from_site_a(ProfiledAllocator &alloc) {
+    return alloc.allocate(sizeof(int));
+}
+
+[[gnu::noinline]] int *allocate_from_site_b(ProfiledAllocator &alloc) {
+    return alloc.allocate(sizeof(int));
+}
+
+bool has_frame_in(const std::string &report, const void *function) {
+    const auto begin = reinterpret_cast<std::uintptr_t>(function);
+    std::istringstream is{report};
+    std::string token{};
+    while (is >> token) {
+        if (token.rfind("0x", 0) != 0) {
+            continue;
+        }
+        const auto frame = std::stoull(token, nullptr, 16);
+        if (frame > begin && frame < begin + 4096) {
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace
+
+TEST(SamplingProfiler, StackTrace) {
+    Allocator::SamplingProfiler profiler{0};
+    ProfiledAllocator alloc{4};
+    alloc.set_profiler(&profiler);
+    EXPECT_TRUE(allocate_from_site_a(alloc));
+    EXPECT_TRUE(allocate_from_site_b(alloc));
+
+    std::ostringstream os{};
+    profiler.report(os);
+    const auto report = os.str();
+    // One line per distinct stack
+    EXPECT_EQ(std::count(report.begin(), report.end(), '\n'), 3);
+    EXPECT_TRUE(has_frame_in(
+        report, reinterpret_cast<const void *>(&allocate_from_site_a)));
+    EXPECT_TRUE(has_frame_in(
+        report, reinterpret_cast<const void *>(&allocate_from_site_b)));
+}
+
+TEST(SamplingProfiler, SharedAcrossThreads) {
+    constexpr int num_threads = 4;
+    Allocator::SamplingProfiler profiler{16};
+    std::vector<std::thread> threads{};
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&profiler] {
+            using Policy = Allocator::ExhaustionPolicy::Block;
+            Allocator::BlockAllocator<int, Policy> alloc{8};
+            alloc.set_profiler(&profiler);
+            for (int i = 0; i < 1000; ++i) {
+                alloc.deallocate(alloc.allocate(sizeof(int)));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(profiler.count_live_samples(), 0);
+}